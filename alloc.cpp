@@ -0,0 +1,168 @@
+#include <cstdlib>
+#include <new>
+
+#include "alloc.h"
+
+// Every allocation is rounded up to this, which suits any object type.
+static const std::size_t ALIGNMENT = 16;
+// Size of a block when no reservation asks for more.
+static const std::size_t DEFAULT_BLOCK = 1 << 20;
+
+static Alloc_counts counts = {0, 0, 0};
+
+static std::size_t align(std::size_t bytes)
+{
+    return (bytes + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+}
+
+Arena::Arena()
+    : head(0), next(0), end(0), allocated(0), reserved(0), nblocks(0)
+{
+}
+
+Arena::~Arena()
+{
+    release();
+}
+
+/**
+ * Ensures that at least bytes can be allocated without a new block.
+ */
+void Arena::reserve(std::size_t bytes)
+{
+    if ((std::size_t) (end - next) < align(bytes))
+        add_block(align(bytes));
+}
+
+/**
+ * Returns bytes of memory aligned for any object type.
+ */
+void* Arena::allocate(std::size_t bytes)
+{
+    bytes = align(bytes);
+    for (std::size_t i = 0; i < free_lists.size(); ++i) {
+        Free_list& list = free_lists[i];
+        if (list.bytes == bytes && list.head) {
+            char* p = list.head;
+            list.head = *reinterpret_cast<char**>(p);
+            if (!list.head)
+                list.tail = 0;
+            return p;
+        }
+    }
+    if ((std::size_t) (end - next) < bytes)
+        add_block(bytes > DEFAULT_BLOCK ? bytes : DEFAULT_BLOCK);
+    void* p = next;
+    next += bytes;
+    allocated += bytes;
+    return p;
+}
+
+/**
+ * Takes back memory from allocate(bytes) for reuse.
+ *
+ * Memory of each size is reused first freed, first allocated, so nodes freed in
+ * list order are handed out again in the order they were laid out.
+ */
+void Arena::deallocate(void* p, std::size_t bytes)
+{
+    if (!p)
+        return;
+    bytes = align(bytes);
+    std::size_t i = 0;
+    while (i < free_lists.size() && free_lists[i].bytes != bytes)
+        ++i;
+    if (i == free_lists.size()) {
+        Free_list list = {bytes, 0, 0};
+        free_lists.push_back(list);
+    }
+    Free_list& list = free_lists[i];
+    *reinterpret_cast<char**>(p) = 0;
+    if (list.tail)
+        *reinterpret_cast<char**>(list.tail) = static_cast<char*>(p);
+    else
+        list.head = static_cast<char*>(p);
+    list.tail = static_cast<char*>(p);
+}
+
+/**
+ * Frees every block. Memory handed out before is no longer valid.
+ */
+void Arena::release()
+{
+    while (head) {
+        char* prev = *reinterpret_cast<char**>(head);
+        std::free(head);
+        head = prev;
+    }
+    next = end = 0;
+    allocated = reserved = nblocks = 0;
+    free_lists.clear();
+}
+
+/**
+ * Starts a new block with room for bytes after its header.
+ *
+ * Whatever is left of the current block is abandoned.
+ */
+void Arena::add_block(std::size_t bytes)
+{
+    const std::size_t header = align(sizeof(char*));
+    char* block = static_cast<char*>(std::malloc(header + bytes));
+    if (!block)
+        throw std::bad_alloc();
+    *reinterpret_cast<char**>(block) = head;
+    head = block;
+    next = block + header;
+    end = next + bytes;
+    reserved += bytes;
+    ++nblocks;
+}
+
+/**
+ * Returns the arena holding the nodes of every Polyhedron.
+ */
+Arena& mesh_arena()
+{
+    static Arena arena;
+    return arena;
+}
+
+/**
+ * Returns the current heap allocation counts.
+ */
+Alloc_counts heap_counts()
+{
+    return counts;
+}
+
+// The global allocation functions are replaced so that every heap allocation,
+// including the ones CGAL makes for lazy exact constructions, is counted.
+
+void* operator new(std::size_t bytes)
+{
+    void* p = std::malloc(bytes ? bytes : 1);
+    if (!p)
+        throw std::bad_alloc();
+    ++counts.allocations;
+    counts.bytes += bytes;
+    return p;
+}
+
+void* operator new[](std::size_t bytes)
+{
+    return operator new(bytes);
+}
+
+void operator delete(void* p) throw()
+{
+    if (!p)
+        return;
+    ++counts.deallocations;
+    std::free(p);
+}
+
+void operator delete[](void* p) throw()
+{
+    operator delete(p);
+}
@@ -0,0 +1,139 @@
+#ifndef __ALLOC_H__
+#define __ALLOC_H__
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+/**
+ * A bump allocator that hands out memory from large blocks.
+ *
+ * Deallocated memory is kept on a list for its size and handed out again in the
+ * order it was freed, so a mesh rebuilt after clear() takes over the old nodes
+ * in sequence. Blocks are only returned to the system by release(). This suits
+ * the halfedge data structure, whose nodes are created in bulk while loading.
+ */
+class Arena {
+    public:
+        Arena();
+        ~Arena();
+
+        /**
+         * Ensures that at least bytes can be allocated without a new block.
+         */
+        void reserve(std::size_t bytes);
+
+        /**
+         * Returns bytes of memory aligned for any object type.
+         */
+        void* allocate(std::size_t bytes);
+
+        /**
+         * Takes back memory from allocate(bytes) for reuse.
+         */
+        void deallocate(void* p, std::size_t bytes);
+
+        /**
+         * Frees every block. Memory handed out before is no longer valid.
+         */
+        void release();
+
+        std::size_t bytes_allocated() const { return allocated; }
+        std::size_t bytes_reserved() const { return reserved; }
+        std::size_t blocks() const { return nblocks; }
+
+    private:
+        Arena(const Arena&);
+        Arena& operator=(const Arena&);
+
+        void add_block(std::size_t bytes);
+
+        // Freed memory of one size, linked through its first word.
+        struct Free_list {
+            std::size_t bytes;
+            char* head;
+            char* tail;
+        };
+
+        char* head; // Most recent block; each block starts with the previous.
+        char* next; // Next free byte in head.
+        char* end; // One past the last byte of head.
+        std::size_t allocated;
+        std::size_t reserved;
+        std::size_t nblocks;
+        std::vector<Free_list> free_lists;
+};
+
+/**
+ * Returns the arena holding the nodes of every Polyhedron.
+ */
+Arena& mesh_arena();
+
+/**
+ * A stateless allocator drawing from mesh_arena().
+ */
+template <class T>
+class Arena_allocator {
+    public:
+        typedef T value_type;
+        typedef T* pointer;
+        typedef const T* const_pointer;
+        typedef T& reference;
+        typedef const T& const_reference;
+        typedef std::size_t size_type;
+        typedef std::ptrdiff_t difference_type;
+
+        template <class U>
+        struct rebind {
+            typedef Arena_allocator<U> other;
+        };
+
+        Arena_allocator() {}
+        template <class U>
+        Arena_allocator(const Arena_allocator<U>&) {}
+
+        pointer address(reference x) const { return &x; }
+        const_pointer address(const_reference x) const { return &x; }
+
+        pointer allocate(size_type n, const void* = 0)
+        {
+            return static_cast<pointer>(mesh_arena().allocate(n * sizeof(T)));
+        }
+        void deallocate(pointer p, size_type n)
+        {
+            mesh_arena().deallocate(p, n * sizeof(T));
+        }
+
+        size_type max_size() const { return size_type(-1) / sizeof(T); }
+
+        void construct(pointer p, const T& value) { new (p) T(value); }
+        void destroy(pointer p) { p->~T(); }
+};
+
+template <class T, class U>
+bool operator==(const Arena_allocator<T>&, const Arena_allocator<U>&)
+{
+    return true;
+}
+
+template <class T, class U>
+bool operator!=(const Arena_allocator<T>&, const Arena_allocator<U>&)
+{
+    return false;
+}
+
+/**
+ * Counts of heap allocations made through operator new since startup.
+ */
+struct Alloc_counts {
+    std::size_t allocations;
+    std::size_t deallocations;
+    std::size_t bytes;
+};
+
+/**
+ * Returns the current heap allocation counts.
+ */
+Alloc_counts heap_counts();
+
+#endif
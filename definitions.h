@@ -5,6 +5,8 @@
 #include <CGAL/Polyhedron_3.h>
 #include <CGAL/Exact_predicates_exact_constructions_kernel.h>
 
+#include "alloc.h"
+
 // template <class Refs, class T, class Point>
 // struct My_vertex : CGAL::HalfedgeDS_vertex_base<Refs, T, Point> {
 //     char type;
@@ -54,7 +56,9 @@ class Tin_Polyhedron_items_3 {
 
 
 typedef CGAL::Exact_predicates_exact_constructions_kernel Kernel;
-typedef CGAL::Polyhedron_3<Kernel, Tin_Polyhedron_items_3> Polyhedron;
+// Nodes come from the mesh arena rather than one heap allocation apiece.
+typedef CGAL::Polyhedron_3<Kernel, Tin_Polyhedron_items_3,
+        CGAL::HalfedgeDS_default, Arena_allocator<int> > Polyhedron;
 
 typedef Polyhedron::Halfedge_iterator Halfedge_iterator;
 typedef Polyhedron::Halfedge_const_iterator Halfedge_const_iterator;
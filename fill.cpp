@@ -0,0 +1,143 @@
+#include <cassert>
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "definitions.h"
+#include "primitives.h"
+#include "fill.h"
+
+static bool DEBUG_FILL = false;
+
+using std::cout;
+using std::endl;
+
+// An open vertex and the elevation it is flooded at.
+typedef std::pair<double, Vertex_handle> Flood_entry;
+
+struct Flood_greater {
+    bool operator()(const Flood_entry& a, const Flood_entry& b) const
+    {
+        return a.first > b.first;
+    }
+};
+
+struct Flood_less {
+    bool operator()(const Flood_entry& a, const Flood_entry& b) const
+    {
+        return a.first < b.first;
+    }
+};
+
+typedef std::priority_queue<Flood_entry, std::vector<Flood_entry>,
+        Flood_greater> Flood_queue;
+
+/**
+ * Determines whether v lies on the border of the mesh.
+ */
+static bool is_border_vertex(const Vertex_const_handle& v)
+{
+    typedef Vertex::Halfedge_around_vertex_const_circulator Circulator;
+    Circulator current = v->vertex_begin();
+    Circulator end = v->vertex_begin();
+    do {
+        if (current->is_border_edge())
+            return true;
+    } while (++current != end);
+    return false;
+}
+
+/**
+ * Floods outward from the vertices in open until it is empty.
+ *
+ * Every vertex reached is added to closed, and raised if it lies in a
+ * depression. Vertices already in closed are not revisited.
+ */
+static void flood(Flood_queue& open, std::set<const Vertex*>& closed,
+        double epsilon, Fill_report& report)
+{
+    while (!open.empty()) {
+        Flood_entry c = open.top();
+        open.pop();
+        typedef Vertex::Halfedge_around_vertex_circulator Circulator;
+        Circulator current = c.second->vertex_begin();
+        Circulator end = c.second->vertex_begin();
+        do {
+            Vertex_handle n = current->opposite()->vertex();
+            if (!closed.insert(&*n).second)
+                continue;
+            double z = CGAL::to_double(n->point().z());
+            // n is in a depression or a flat draining through c.
+            if (z <= c.first && c.first + epsilon > z) {
+                double raised_z = c.first + epsilon;
+                if (DEBUG_FILL)
+                    cout << "Raising " << n->point() << " to " << raised_z
+                        << endl;
+                n->point() = Point_3(n->point().x(), n->point().y(),
+                        raised_z);
+                ++report.raised;
+                report.total_raise += raised_z - z;
+                if (raised_z - z > report.max_raise)
+                    report.max_raise = raised_z - z;
+                z = raised_z;
+            }
+            open.push(Flood_entry(z, n));
+        } while (++current != end);
+    }
+}
+
+/**
+ * Fills the depressions of p so that every vertex drains to the border.
+ *
+ * Uses a priority-flood over the vertex graph seeded with the border vertices.
+ * Each vertex reached from a lower or equal neighbor is raised to epsilon above
+ * that neighbor, so filled areas keep a gradient toward their outlet. A zero
+ * epsilon leaves filled areas flat. A component with no border, such as a
+ * closed surface, is flooded from its lowest vertex, which then acts as its
+ * outlet. Facet planes are recalculated.
+ */
+Fill_report fill_depressions(Polyhedron& p, double epsilon)
+{
+    Fill_report report = {0, 0.0, 0.0, 0};
+    std::set<const Vertex*> closed;
+    Flood_queue open;
+    for (Vertex_iterator i = p.vertices_begin(); i != p.vertices_end(); ++i) {
+        if (is_border_vertex(i)) {
+            closed.insert(&*i);
+            open.push(Flood_entry(CGAL::to_double(i->point().z()), i));
+        }
+    }
+    flood(open, closed, epsilon, report);
+
+    if (closed.size() < p.size_of_vertices()) {
+        // Whatever is left lies in components the border flood cannot reach.
+        // The lowest vertex left is always the lowest of a new component.
+        std::vector<Flood_entry> rest;
+        for (Vertex_iterator i = p.vertices_begin(); i != p.vertices_end();
+                ++i) {
+            if (!closed.count(&*i))
+                rest.push_back(Flood_entry(CGAL::to_double(i->point().z()),
+                            i));
+        }
+        std::stable_sort(rest.begin(), rest.end(), Flood_less());
+        for (std::size_t i = 0; i < rest.size(); ++i) {
+            if (!closed.insert(&*rest[i].second).second)
+                continue;
+            if (DEBUG_FILL)
+                cout << "Flooding closed component from "
+                    << rest[i].second->point() << endl;
+            ++report.closed_components;
+            open.push(rest[i]);
+            flood(open, closed, epsilon, report);
+        }
+    }
+    assert(closed.size() == p.size_of_vertices());
+
+    if (report.raised > 0)
+        std::transform(p.facets_begin(), p.facets_end(), p.planes_begin(),
+                Plane_equation());
+    return report;
+}
@@ -0,0 +1,30 @@
+#ifndef __FILL_H__
+#define __FILL_H__
+
+#include <cstddef>
+
+#include "definitions.h"
+
+/**
+ * Summary of the changes made by fill_depressions.
+ */
+struct Fill_report {
+    std::size_t raised; // Number of vertices raised.
+    double max_raise; // Largest amount any vertex was raised by.
+    double total_raise; // Sum of the amounts all vertices were raised by.
+    std::size_t closed_components; // Components without a border vertex.
+};
+
+/**
+ * Fills the depressions of p so that every vertex drains to the border.
+ *
+ * Uses a priority-flood over the vertex graph seeded with the border vertices.
+ * Each vertex reached from a lower or equal neighbor is raised to epsilon above
+ * that neighbor, so filled areas keep a gradient toward their outlet. A zero
+ * epsilon leaves filled areas flat. A component with no border, such as a
+ * closed surface, is flooded from its lowest vertex, which then acts as its
+ * outlet. Facet planes are recalculated.
+ */
+Fill_report fill_depressions(Polyhedron& p, double epsilon);
+
+#endif
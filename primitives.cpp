@@ -1,55 +1,6 @@
-#include <cassert>
-
 #include "definitions.h"
 #include "primitives.h"
 
-static bool DEBUG_PRIM = false;
-
-using std::cout;
-using std::endl;
-
-/**
- * Determines whether the left facet of a halfedge slopes into it.
- *
- * If the halfedge is on the border, returns false. Otherwise, uses the normal
- * of the adjacent face to determine whether the face is sloping into or away
- * from the halfedge.
- */
-bool slopes_into(const Halfedge_const_handle& h)
-{
-    if (h->type == IN)
-        return true;
-    else if (h->type == OUT)
-        return false;
-
-    if (h->is_border())
-        return false;
-    Vector_3 normal;
-    if (is_flat_plane(h->facet()->plane()))
-        normal = Vector_3(-1.0, 0.0, 0.0);
-    else
-        normal = h->facet()->plane().orthogonal_vector();
-    // Origin of h
-    const Point_3 origin_3 = h->opposite()->vertex()->point();
-    const Point_2 origin_2 = Point_2(origin_3.x(), origin_3.y());
-    // Dest of h
-    const Point_3 dest_3 = h->vertex()->point();
-    const Point_2 dest_2 = Point_2(dest_3.x(), dest_3.y());
-    // Displacement by flow direction of h
-    const Point_3 disp_point_3 = origin_3 + normal;
-    const Point_2 disp_point_2 = Point_2(disp_point_3.x(), disp_point_3.y());
-    
-    if (DEBUG_PRIM) {
-        cout << "Normal: " << normal << endl;
-        cout << "Origin: " << origin_3 << endl;
-        cout << "Dest: " << dest_3 << endl;
-        cout << "Disp: " << disp_point_3 << endl;
-    }
-
-    CGAL::Orientation o = orientation(origin_2, dest_2, disp_point_2);
-    return (o == CGAL::RIGHT_TURN);
-}
-
 /**
  * Determines whether a plane is flat.
  */
@@ -58,98 +9,6 @@ bool is_flat_plane(const Plane_3& h)
     return h.a() == 0.0 && h.b() == 0.0;
 }
 
-/**
- * Determines whether h is a ridge.
- */
-bool is_ridge(const Halfedge_const_handle& h)
-{
-    bool ret_val = !(slopes_into(h) || slopes_into(h->opposite()));
-    if (DEBUG_PRIM) {
-        cout << (ret_val ? "" : "Not ") << "Ridge:" << endl;
-        print_halfedge(h);
-    }
-    return ret_val;
-}
-
-/**
- * Determines whether h is a channel.
- */
-bool is_channel(const Halfedge_const_handle& h)
-{
-    bool ret_val = slopes_into(h) && slopes_into(h->opposite());
-    if (DEBUG_PRIM) {
-        cout << (ret_val ? "" : "Not ") << "Channel:" << endl;
-        print_halfedge(h);
-    }
-    return ret_val;
-}
-
-/**
- * Determines whether h is transverse.
- */
-bool is_transverse(const Halfedge_const_handle& h)
-{
-    bool ret_val = ((slopes_into(h) && !slopes_into(h->opposite())) ||
-            (!slopes_into(h) && slopes_into(h->opposite())));
-    if (DEBUG_PRIM) {
-        cout << (ret_val ? "" : "Not ") << "Transverse:" << endl;
-        print_halfedge(h);
-    }
-    return ret_val;
-}
-
-/**
- * Is there a generalized ridge up the face left of h starting at h's vertex?
- *
- * A generalized ridge is an upslope line through which water does not flow. A
- * generalized ridge can be found by determining whether water flows into both
- * edges adjacent to the point through which it runs. No generalized ridges run
- * through the infinity face.
- */
-bool is_generalized_ridge(const Halfedge_const_handle& h)
-{
-    bool ret_val;
-    if (h->is_border()) {
-        assert(h->next()->is_border());
-        ret_val = false;
-    }
-    else {
-       ret_val = (slopes_into(h) && slopes_into(h->next()));
-    }
-    if (DEBUG_PRIM) {
-        cout << (ret_val ? "" : "Not ") << "Generalized Ridge:" << endl;
-        print_halfedge(h);
-        print_halfedge(h->next());
-    }
-    return ret_val;
-}
-
-/**
- * Is there a generalized channel up the face left of h starting at h's vertex?
- *
- * A generalized channel is a downslope line through which water does not flow. A
- * generalized channel can be found by determining whether water flows into both
- * edges adjacent to the point through which it runs. No generalized channels run
- * through the infinity face.
- */
-bool is_generalized_channel(const Halfedge_const_handle& h)
-{
-    bool ret_val;
-    if (h->is_border()) {
-        assert(h->next()->is_border());
-        ret_val = false;
-    }
-    else {
-       ret_val = !(slopes_into(h) || slopes_into(h->next()));
-    }
-    if (DEBUG_PRIM) {
-        cout << (ret_val ? "" : "Not ") << "Generalized Channel:" << endl;
-        print_halfedge(h);
-        print_halfedge(h->next());
-    }
-    return ret_val;
-}
-
 /**
  * True if u is steeper than v. Uses the square of slope to avoid sqrt.
  */
@@ -162,88 +21,29 @@ bool is_steeper(Vector_3 u, Vector_3 v)
 }
 
 /**
- * Finds the exit point of upslope_path on the facet left of h.
- *
- * upslope_path must intersect the boundary of the facet in 2 points or a
- * segment. One of these points must be start_point. If the intersection is a
- * segment, returns the endpoint that is not start_point. Otherwise returns the
- * other intersection point. Updates h so it is the halfedge where the
- * intersection is found.
- */
-Point_2 find_exit(Halfedge_handle& h, const Ray_2& upslope_path, 
-        const Point_2& start_point)
-{
-    Point_2 exit;
-    Plane_3 plane = h->facet()->plane();
-    typedef Facet::Halfedge_around_facet_circulator Circulator;
-    Circulator current = h->facet()->facet_begin();
-    Circulator end = h->facet()->facet_begin();
-
-    do {
-        Point_2 source = plane.to_2d(current->vertex()->point());
-        Point_2 target = plane.to_2d(current->opposite()->vertex()->point());
-        Segment_2 seg = Segment_2(source, target);
-        // Example pulled from http://tinyurl.com/intersect-doc
-        CGAL::Object intersect = CGAL::intersection(upslope_path, seg);
-        // Return for a point intersection
-        if (const CGAL::Point_2<Kernel> *ipoint =
-                CGAL::object_cast<CGAL::Point_2<Kernel> >(&intersect)) {
-            if (*ipoint != start_point) {
-                h = current;
-                return *ipoint;
-            }
-        } 
-        // Return the opposite point of the segment for a segment intersection.
-        else if (const CGAL::Segment_2<Kernel> *iseg =
-                CGAL::object_cast<CGAL::Segment_2<Kernel> >(&intersect)) {
-            h = current;
-            if (iseg->source() == start_point)
-                return iseg->target();
-            return iseg->source();
-        } 
-    } while (++current != end);
-    cout << "Failed to find an intersection point." << endl;
-    cout << "Start: " << start_point << endl;
-    cout << "Upslope path: " << upslope_path << endl;
-    print_facet(*h->facet());
-    std::abort();
-    return exit;
-}
-
-/**
- * Prints all points adjacent to the input vertex.
+ * Returns the point at fraction t of the way from source to target.
  */
-void print_neighborhood(const Vertex& v)
+Point_2 edge_point(const Point_2& source, const Point_2& target, double t)
 {
-    cout << "Printing points around " << v.point() << endl;
-    typedef Vertex::Halfedge_around_vertex_const_circulator Circulator;
-    Circulator current = v.vertex_begin();
-    Circulator end = v.vertex_begin();
-    do {
-        cout << current->opposite()->vertex()->point() << endl;
-    } while (++current != end);
-    cout << endl;
+    if (t >= 1.0)
+        return target;
+    return source + (target - source) * Kernel::FT(t);
 }
 
 /**
- * Prints the two points of a halfedge.
- */
-void print_halfedge(const Halfedge_const_handle& h)
-{
-    cout << h->opposite()->vertex()->point() << endl;
-    cout << h->vertex()->point() << endl;
-}
-
-/**
- * Prints the points around a facet.
- */
-void print_facet(const Facet& f)
-{
-    typedef Vertex::Halfedge_around_facet_const_circulator Circulator;
-    Circulator current = f.facet_begin();
-    Circulator end = f.facet_begin();
-    do {
-        cout << current->vertex()->point() << endl;
-    } while (++current != end);
-    cout << endl;
+ * Returns the fraction of the way from source to target at which q lies.
+ *
+ * q must be on the segment from source to target. The fraction is computed in
+ * double precision, so the result refers only to source and target.
+ */
+double edge_parameter(const Point_2& source, const Point_2& target,
+        const Point_2& q)
+{
+    double sx = CGAL::to_double(source.x());
+    double sy = CGAL::to_double(source.y());
+    double dx = CGAL::to_double(target.x()) - sx;
+    double dy = CGAL::to_double(target.y()) - sy;
+    double qx = CGAL::to_double(q.x()) - sx;
+    double qy = CGAL::to_double(q.y()) - sy;
+    return (qx * dx + qy * dy) / (dx * dx + dy * dy);
 }
@@ -1,6 +1,14 @@
 #ifndef __PRIMITIVES_H__
 #define __PRIMITIVES_H__
 
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+
+#include "definitions.h"
+
+const bool DEBUG_PRIM = false;
+
 /**
  * operator() calculates returns the plane for a given facet.
  */
@@ -15,6 +23,101 @@ struct Plane_equation {
     }
 };
 
+/**
+ * Gives the halfedge handle type that goes with a vertex handle type.
+ *
+ * The primitives below are templates over the handle type, so they serve both
+ * Polyhedron handles and the implicit halfedges of a Raster. A handle type must
+ * offer opposite(), next(), vertex(), facet(), is_border() and type, and its
+ * vertices point() and halfedge(), as Polyhedron handles do.
+ */
+template <class V>
+struct Vertex_traits;
+
+template <>
+struct Vertex_traits<Vertex_handle> {
+    typedef Halfedge_handle Halfedge;
+};
+
+template <>
+struct Vertex_traits<Vertex_const_handle> {
+    typedef Halfedge_const_handle Halfedge;
+};
+
+/**
+ * Returns the next halfedge clockwise into the vertex of h.
+ *
+ * This is the step a Halfedge_around_vertex_circulator takes.
+ */
+template <class H>
+H next_around_vertex(const H& h)
+{
+    return h->next()->opposite();
+}
+
+/**
+ * Determines whether a plane is flat.
+ */
+bool is_flat_plane(const Plane_3& h);
+
+/**
+ * True if u is steeper than v. Uses the square of slope to avoid sqrt.
+ */
+bool is_steeper(Vector_3 u, Vector_3 v);
+
+/**
+ * Returns the point at fraction t of the way from source to target.
+ */
+Point_2 edge_point(const Point_2& source, const Point_2& target, double t);
+
+/**
+ * Returns the fraction of the way from source to target at which q lies.
+ *
+ * q must be on the segment from source to target. The fraction is computed in
+ * double precision, so the result refers only to source and target.
+ */
+double edge_parameter(const Point_2& source, const Point_2& target,
+        const Point_2& q);
+
+/**
+ * Prints the two points of a halfedge.
+ */
+template <class H>
+void print_halfedge(const H& h)
+{
+    std::cout << h->opposite()->vertex()->point() << std::endl;
+    std::cout << h->vertex()->point() << std::endl;
+}
+
+/**
+ * Prints the points around the facet left of h.
+ */
+template <class H>
+void print_facet(const H& h)
+{
+    H current = h;
+    do {
+        std::cout << current->vertex()->point() << std::endl;
+    } while ((current = current->next()) != h);
+    std::cout << std::endl;
+}
+
+/**
+ * Prints all points adjacent to the input vertex.
+ */
+template <class V>
+void print_neighborhood(const V& v)
+{
+    typedef typename Vertex_traits<V>::Halfedge Halfedge_type;
+    std::cout << "Printing points around " << v->point() << std::endl;
+    const Halfedge_type end = v->halfedge();
+    Halfedge_type current = end;
+    do {
+        std::cout << current->opposite()->vertex()->point() << std::endl;
+    } while ((current = next_around_vertex(current)) != end);
+    std::cout << std::endl;
+}
+
 /**
  * Determines whether the left facet of a halfedge slopes into it.
  *
@@ -22,77 +125,197 @@ struct Plane_equation {
  * of the adjacent face to determine whether the face is sloping into or away
  * from the halfedge.
  */
-bool slopes_into(const Halfedge_const_handle& h);
+template <class H>
+bool slopes_into(const H& h)
+{
+    if (h->type == IN)
+        return true;
+    else if (h->type == OUT)
+        return false;
+
+    if (h->is_border())
+        return false;
+    const Plane_3 plane = h->facet()->plane();
+    Vector_3 normal;
+    if (is_flat_plane(plane))
+        normal = Vector_3(-1.0, 0.0, 0.0);
+    else
+        normal = plane.orthogonal_vector();
+    // Origin of h
+    const Point_3 origin_3 = h->opposite()->vertex()->point();
+    const Point_2 origin_2 = Point_2(origin_3.x(), origin_3.y());
+    // Dest of h
+    const Point_3 dest_3 = h->vertex()->point();
+    const Point_2 dest_2 = Point_2(dest_3.x(), dest_3.y());
+    // Displacement by flow direction of h
+    const Point_3 disp_point_3 = origin_3 + normal;
+    const Point_2 disp_point_2 = Point_2(disp_point_3.x(), disp_point_3.y());
+
+    if (DEBUG_PRIM) {
+        std::cout << "Normal: " << normal << std::endl;
+        std::cout << "Origin: " << origin_3 << std::endl;
+        std::cout << "Dest: " << dest_3 << std::endl;
+        std::cout << "Disp: " << disp_point_3 << std::endl;
+    }
+
+    CGAL::Orientation o = orientation(origin_2, dest_2, disp_point_2);
+    return (o == CGAL::RIGHT_TURN);
+}
 
 /**
- * Determines whether a plane is flat.
+ * Determines whether h is a ridge.
  */
-bool is_flat_plane(const Plane_3& h);
+template <class H>
+bool is_ridge(const H& h)
+{
+    bool ret_val = !(slopes_into(h) || slopes_into(h->opposite()));
+    if (DEBUG_PRIM) {
+        std::cout << (ret_val ? "" : "Not ") << "Ridge:" << std::endl;
+        print_halfedge(h);
+    }
+    return ret_val;
+}
 
 /**
- * Determines whether h is a ridge.
+ * Determines whether h is a ridge rising from h's vertex to its source.
  */
-bool is_ridge(const Halfedge_const_handle& h);
+template <class H>
+bool is_upslope_ridge(const H& h)
+{
+    return is_ridge(h) &&
+        h->opposite()->vertex()->point().z() > h->vertex()->point().z();
+}
 
 /**
  * Determines whether h is a channel.
  */
-bool is_channel(const Halfedge_const_handle& h);
+template <class H>
+bool is_channel(const H& h)
+{
+    bool ret_val = slopes_into(h) && slopes_into(h->opposite());
+    if (DEBUG_PRIM) {
+        std::cout << (ret_val ? "" : "Not ") << "Channel:" << std::endl;
+        print_halfedge(h);
+    }
+    return ret_val;
+}
 
 /**
  * Determines whether h is transverse.
  */
-bool is_transverse(const Halfedge_const_handle& h);
+template <class H>
+bool is_transverse(const H& h)
+{
+    bool ret_val = ((slopes_into(h) && !slopes_into(h->opposite())) ||
+            (!slopes_into(h) && slopes_into(h->opposite())));
+    if (DEBUG_PRIM) {
+        std::cout << (ret_val ? "" : "Not ") << "Transverse:" << std::endl;
+        print_halfedge(h);
+    }
+    return ret_val;
+}
 
 /**
- * Determines whether there is a generalized ridge up the face left of h.
+ * Is there a generalized ridge up the face left of h starting at h's vertex?
  *
  * A generalized ridge is an upslope line through which water does not flow. A
  * generalized ridge can be found by determining whether water flows into both
  * edges adjacent to the point through which it runs. No generalized ridges run
  * through the infinity face.
  */
-bool is_generalized_ridge(const Halfedge_const_handle& h);
+template <class H>
+bool is_generalized_ridge(const H& h)
+{
+    bool ret_val;
+    if (h->is_border()) {
+        assert(h->next()->is_border());
+        ret_val = false;
+    }
+    else {
+       ret_val = (slopes_into(h) && slopes_into(h->next()));
+    }
+    if (DEBUG_PRIM) {
+        std::cout << (ret_val ? "" : "Not ") << "Generalized Ridge:"
+            << std::endl;
+        print_halfedge(h);
+        print_halfedge(h->next());
+    }
+    return ret_val;
+}
 
 /**
- * Determines whether there is a generalized channel up the face left of h.
+ * Is there a generalized channel up the face left of h starting at h's vertex?
  *
  * A generalized channel is a downslope line through which water does not flow. A
  * generalized channel can be found by determining whether water flows into both
  * edges adjacent to the point through which it runs. No generalized channels run
  * through the infinity face.
  */
-bool is_generalized_channel(const Halfedge_const_handle& h);
-
-/**
- * True if u is steeper than v. Uses the square of slope to avoid sqrt.
- */
-bool is_steeper(Vector_3 u, Vector_3 v);
-
-/**
- * Prints all points adjacent to the input vertex.
- */
-void print_neighborhood(const Vertex& v);
-
-/**
- * Prints the two points of a halfedge.
- */
-void print_halfedge(const Halfedge_const_handle& h);
+template <class H>
+bool is_generalized_channel(const H& h)
+{
+    bool ret_val;
+    if (h->is_border()) {
+        assert(h->next()->is_border());
+        ret_val = false;
+    }
+    else {
+       ret_val = !(slopes_into(h) || slopes_into(h->next()));
+    }
+    if (DEBUG_PRIM) {
+        std::cout << (ret_val ? "" : "Not ") << "Generalized Channel:"
+            << std::endl;
+        print_halfedge(h);
+        print_halfedge(h->next());
+    }
+    return ret_val;
+}
 
 /**
  * Finds the exit point of upslope_path on the facet left of h.
  *
- * upslope_path must intersect the boundary of the facet in 2 points or a
- * segment. One of these points must be start_point. If the intersection is a
- * segment, returns the endpoint that is not start_point. Otherwise returns the
- * other intersection point.
- */
-Point_2 find_exit(Halfedge_handle& h, const Ray_2& upslope_path,
-        const Point_2& start_point);
-
-/**
- * Prints the points around a facet.
+ * upslope_path must intersect the xy projection of the boundary of the facet
+ * in 2 points or a segment. One of these points must be start_point. If the
+ * intersection is a segment, returns the endpoint that is not start_point.
+ * Otherwise returns the other intersection point. Updates h so it is the
+ * halfedge where the intersection is found.
  */
-void print_facet(const Facet& f);
+template <class H>
+Point_2 find_exit(H& h, const Ray_2& upslope_path,
+        const Point_2& start_point)
+{
+    Point_2 exit;
+    H current = h;
+    do {
+        const Point_3& source_3 = current->vertex()->point();
+        const Point_3& target_3 = current->opposite()->vertex()->point();
+        Segment_2 seg = Segment_2(Point_2(source_3.x(), source_3.y()),
+                Point_2(target_3.x(), target_3.y()));
+        // Example pulled from http://tinyurl.com/intersect-doc
+        CGAL::Object intersect = CGAL::intersection(upslope_path, seg);
+        // Return for a point intersection
+        if (const CGAL::Point_2<Kernel> *ipoint =
+                CGAL::object_cast<CGAL::Point_2<Kernel> >(&intersect)) {
+            if (*ipoint != start_point) {
+                h = current;
+                return *ipoint;
+            }
+        }
+        // Return the opposite point of the segment for a segment intersection.
+        else if (const CGAL::Segment_2<Kernel> *iseg =
+                CGAL::object_cast<CGAL::Segment_2<Kernel> >(&intersect)) {
+            h = current;
+            if (iseg->source() == start_point)
+                return iseg->target();
+            return iseg->source();
+        }
+    } while ((current = current->next()) != h);
+    std::cout << "Failed to find an intersection point." << std::endl;
+    std::cout << "Start: " << start_point << std::endl;
+    std::cout << "Upslope path: " << upslope_path << std::endl;
+    print_facet(h);
+    std::abort();
+    return exit;
+}
 
 #endif
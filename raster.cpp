@@ -0,0 +1,197 @@
+#include <cassert>
+#include <cctype>
+#include <cstdlib>
+#include <algorithm>
+#include <fstream>
+
+#include "definitions.h"
+#include "raster.h"
+
+static bool DEBUG_RASTER = false;
+
+using std::cout;
+using std::endl;
+
+// Grid offsets of the neighbor in each Raster::Direction. Rows grow southward.
+static const int COL_OFFSET[6] = {1, 0, -1, -1, 0, 1};
+static const int ROW_OFFSET[6] = {0, -1, -1, 0, 1, 1};
+
+Raster::Raster()
+    : nrows(0), ncols(0), xll(0.0), yll(0.0), cellsize(1.0),
+    has_nodata(false), nodata(0.0f)
+{
+}
+
+/**
+ * Reads the grid described by the ESRI header hdr_name.
+ *
+ * The samples are read from the file with the same name and a .flt extension.
+ * Returns false if either file cannot be read.
+ */
+bool Raster::read(const std::string& hdr_name)
+{
+    std::ifstream header(hdr_name.c_str());
+    if (!header)
+        return false;
+    bool centered = false;
+    bool msb_first = false;
+    std::string key, value;
+    while (header >> key >> value) {
+        std::transform(key.begin(), key.end(), key.begin(), ::tolower);
+        if (key == "ncols")
+            ncols = std::atol(value.c_str());
+        else if (key == "nrows")
+            nrows = std::atol(value.c_str());
+        else if (key == "xllcorner" || key == "xllcenter") {
+            xll = std::atof(value.c_str());
+            centered = (key == "xllcenter");
+        }
+        else if (key == "yllcorner" || key == "yllcenter")
+            yll = std::atof(value.c_str());
+        else if (key == "cellsize")
+            cellsize = std::atof(value.c_str());
+        else if (key == "nodata_value") {
+            has_nodata = true;
+            nodata = std::atof(value.c_str());
+        }
+        else if (key == "byteorder")
+            msb_first = (value == "MSBFIRST" || value == "msbfirst");
+    }
+    if (nrows == 0 || ncols == 0)
+        return false;
+    // Samples sit at cell centers.
+    if (!centered) {
+        xll += cellsize / 2;
+        yll += cellsize / 2;
+    }
+
+    std::string flt_name = hdr_name.substr(0, hdr_name.rfind('.')) + ".flt";
+    std::ifstream samples(flt_name.c_str(), std::ios::binary);
+    if (!samples)
+        return false;
+    z.resize(nrows * ncols);
+    samples.read(reinterpret_cast<char*>(&z[0]), z.size() * sizeof(float));
+    if (!samples)
+        return false;
+
+    const unsigned int one = 1;
+    const bool host_msb_first = *reinterpret_cast<const char*>(&one) == 0;
+    if (msb_first != host_msb_first) {
+        for (std::size_t i = 0; i < z.size(); ++i) {
+            char* bytes = reinterpret_cast<char*>(&z[i]);
+            std::reverse(bytes, bytes + sizeof(float));
+        }
+    }
+    if (DEBUG_RASTER)
+        cout << "Read " << nrows << "x" << ncols << " grid from " << flt_name
+            << endl;
+    return true;
+}
+
+/**
+ * Returns the location of vertex v.
+ */
+Point_3 Raster::point(std::size_t v) const
+{
+    std::size_t row = v / ncols;
+    std::size_t col = v % ncols;
+    return Point_3(xll + col * cellsize, yll + (nrows - 1 - row) * cellsize,
+            z[v]);
+}
+
+/**
+ * Determines whether sample v is a vertex of the triangulation.
+ *
+ * A sample is left out if it is void or if all its neighbors are.
+ */
+bool Raster::is_vertex(std::size_t v) const
+{
+    if (is_void(v))
+        return false;
+    for (int d = 0; d < 6; ++d) {
+        if (has_neighbor(v, d))
+            return true;
+    }
+    return false;
+}
+
+/**
+ * Determines whether v has a neighbor in direction d.
+ *
+ * Void samples are never neighbors.
+ */
+bool Raster::has_neighbor(std::size_t v, int d) const
+{
+    long row = v / ncols + ROW_OFFSET[d];
+    long col = v % ncols + COL_OFFSET[d];
+    if (row < 0 || row >= (long) nrows || col < 0 || col >= (long) ncols)
+        return false;
+    return !is_void(row * ncols + col);
+}
+
+/**
+ * Returns the neighbor of v in direction d, which must exist.
+ */
+std::size_t Raster::neighbor(std::size_t v, int d) const
+{
+    assert(has_neighbor(v, d));
+    return v + ROW_OFFSET[d] * (long) ncols + COL_OFFSET[d];
+}
+
+/**
+ * Returns a halfedge pointing into this vertex.
+ */
+Raster_halfedge Raster_vertex::halfedge() const
+{
+    int d = 0;
+    while (d < 6 && !raster->has_neighbor(v, d))
+        ++d;
+    assert(d < 6);
+    return Raster_halfedge(raster, v, d);
+}
+
+Raster_halfedge Raster_halfedge::opposite() const
+{
+    return Raster_halfedge(raster, raster->neighbor(v, d), (d + 3) % 6);
+}
+
+/**
+ * Returns the halfedge leaving vertex() that follows this one.
+ *
+ * Inside a facet that is the edge to the next neighbor clockwise. On a border
+ * the next existing neighbor clockwise is used instead, so that circulating
+ * with next()->opposite() visits every neighbor, as on a Polyhedron.
+ */
+Raster_halfedge Raster_halfedge::next() const
+{
+    int e = (d + 5) % 6;
+    while (!raster->has_neighbor(v, e))
+        e = (e + 5) % 6;
+    return Raster_halfedge(raster, raster->neighbor(v, e), (e + 3) % 6);
+}
+
+Raster_halfedge Raster_halfedge::prev() const
+{
+    assert(!is_border());
+    return Raster_halfedge(raster, raster->neighbor(v, d), (d + 4) % 6);
+}
+
+/**
+ * Determines whether there is no facet to the left of this halfedge.
+ */
+bool Raster_halfedge::is_border() const
+{
+    return !raster->has_neighbor(v, (d + 5) % 6);
+}
+
+/**
+ * Returns the plane of the facet to the left of this halfedge.
+ *
+ * The points are taken in the same order as Plane_equation uses on a facet.
+ */
+Plane_3 Raster_halfedge::plane() const
+{
+    assert(!is_border());
+    return Plane_3(raster->point(v), next().vertex().point(),
+            opposite().vertex().point());
+}
@@ -0,0 +1,185 @@
+#ifndef __RASTER_H__
+#define __RASTER_H__
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "definitions.h"
+#include "primitives.h"
+#include "utils.h"
+
+/**
+ * A regular grid DEM whose triangulation is implicit in the grid indices.
+ *
+ * Samples are stored as float32 in row-major order with row 0 at the north
+ * edge, as in an ESRI .hdr/.flt pair. Every cell is split along the diagonal
+ * from its north-west to its south-east corner, so an interior vertex has six
+ * neighbors. Vertices are identified by their index into the sample array, and
+ * no adjacency is stored. Samples equal to the header's NODATA_value are left
+ * out of the triangulation, so the surface has a border around them.
+ */
+class Raster {
+    public:
+        /**
+         * Directions to the neighbors of a vertex, in counterclockwise order.
+         */
+        enum Direction { EAST, NORTH, NORTH_WEST, WEST, SOUTH, SOUTH_EAST };
+
+        Raster();
+
+        /**
+         * Reads the grid described by the ESRI header hdr_name.
+         *
+         * The samples are read from the file with the same name and a .flt
+         * extension. Returns false if either file cannot be read.
+         */
+        bool read(const std::string& hdr_name);
+
+        std::size_t rows() const { return nrows; }
+        std::size_t cols() const { return ncols; }
+        std::size_t size_of_vertices() const { return z.size(); }
+
+        /**
+         * Returns the location of vertex v.
+         */
+        Point_3 point(std::size_t v) const;
+
+        /**
+         * Determines whether sample v holds NODATA_value.
+         */
+        bool is_void(std::size_t v) const
+        {
+            return has_nodata && z[v] == nodata;
+        }
+
+        /**
+         * Determines whether sample v is a vertex of the triangulation.
+         *
+         * A sample is left out if it is void or if all its neighbors are.
+         */
+        bool is_vertex(std::size_t v) const;
+
+        /**
+         * Determines whether v has a neighbor in direction d.
+         *
+         * Void samples are never neighbors.
+         */
+        bool has_neighbor(std::size_t v, int d) const;
+
+        /**
+         * Returns the neighbor of v in direction d, which must exist.
+         */
+        std::size_t neighbor(std::size_t v, int d) const;
+
+    private:
+        std::size_t nrows;
+        std::size_t ncols;
+        double xll;
+        double yll;
+        double cellsize;
+        bool has_nodata;
+        float nodata;
+        std::vector<float> z;
+};
+
+class Raster_halfedge;
+
+/**
+ * A vertex of a Raster, identified by its index into the sample array.
+ *
+ * Like the halfedge below, it acts as its own handle so that the templated
+ * primitives can use it as they would a Vertex_handle.
+ */
+class Raster_vertex {
+    public:
+        Raster_vertex() : raster(0), v(0) {}
+        Raster_vertex(const Raster* r, std::size_t vertex)
+            : raster(r), v(vertex) {}
+
+        const Raster_vertex* operator->() const { return this; }
+
+        std::size_t index() const { return v; }
+        Point_3 point() const { return raster->point(v); }
+
+        /**
+         * Returns a halfedge pointing into this vertex.
+         */
+        Raster_halfedge halfedge() const;
+
+        bool operator==(const Raster_vertex& u) const { return v == u.v; }
+        bool operator!=(const Raster_vertex& u) const { return v != u.v; }
+
+    private:
+        const Raster* raster;
+        std::size_t v;
+};
+
+/**
+ * A halfedge of a Raster pointing into a vertex from one of its neighbors.
+ *
+ * The halfedge runs from the neighbor of vertex() in direction() to vertex().
+ * Its left facet lies between that neighbor and the next one clockwise. This
+ * offers the parts of the Polyhedron halfedge interface that the primitives
+ * need, computed arithmetically from the grid.
+ */
+class Raster_halfedge {
+    public:
+        Raster_halfedge() : raster(0), v(0), d(0) {}
+        Raster_halfedge(const Raster* r, std::size_t vertex, int direction)
+            : raster(r), v(vertex), d(direction) {}
+
+        const Raster_halfedge* operator->() const { return this; }
+
+        // Raster edges are never labelled, so their slopes are always computed.
+        static const EdgeType type = NO_TYPE;
+
+        const Raster& grid() const { return *raster; }
+        Raster_vertex vertex() const { return Raster_vertex(raster, v); }
+        int direction() const { return d; }
+
+        Raster_halfedge opposite() const;
+        Raster_halfedge next() const;
+        Raster_halfedge prev() const;
+
+        /**
+         * Determines whether there is no facet to the left of this halfedge.
+         */
+        bool is_border() const;
+
+        /**
+         * Returns the facet to the left of this halfedge.
+         *
+         * A raster facet is represented by this halfedge, which supplies its
+         * plane.
+         */
+        const Raster_halfedge& facet() const { return *this; }
+
+        /**
+         * Returns the plane of the facet to the left of this halfedge.
+         */
+        Plane_3 plane() const;
+
+        bool operator==(const Raster_halfedge& h) const
+        {
+            return v == h.v && d == h.d;
+        }
+        bool operator!=(const Raster_halfedge& h) const { return !(*this == h); }
+
+    private:
+        const Raster* raster;
+        std::size_t v;
+        int d;
+};
+
+template <>
+struct Vertex_traits<Raster_vertex> {
+    typedef Raster_halfedge Halfedge;
+};
+
+/**
+ * A point on an upslope trace over a Raster, as Trace_point is for meshes.
+ */
+typedef Basic_trace_point<Raster_halfedge> Raster_trace_point;
+
+#endif
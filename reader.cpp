@@ -12,14 +12,25 @@
 #include <vector>
 #include <iterator>
 #include <algorithm>
+#include <limits>
+#include <string>
 
 #include <CGAL/IO/Geomview_stream.h>
 #include <CGAL/IO/Polyhedron_geomview_ostream.h>
 
 #include <cassert>
+#include <csignal>
+#include <cstdlib>
+#include <unistd.h>
 
+#include "alloc.h"
 #include "definitions.h"
+#include "fill.h"
 #include "primitives.h"
+#include "raster.h"
+#include "reorder.h"
+#include "schedule.h"
+#include "simplify.h"
 #include "utils.h"
 #include "watershed.h"
 
@@ -29,18 +40,216 @@ static bool DEBUG_READER = false;
 using std::cout;
 using std::endl;
 
-int main(int argc, char** argv)
+static void usage(const char* name)
+{
+    cout << "Usage: " << name << " [-r] [-z] [-f epsilon] [-s tolerance]"
+        << " [-t seconds] [-n steps] [input file]" << endl;
+    cout << "  -r            Read a float32 raster DEM from an ESRI .hdr/.flt"
+        << " pair." << endl;
+    cout << "  -z            Renumber the mesh along a Morton curve before"
+        << " tracing and" << endl;
+    cout << "                report phase times before and after." << endl;
+    cout << "  -f epsilon    Fill depressions before tracing, leaving a gradient"
+        << " of" << endl;
+    cout << "                epsilon across filled areas." << endl;
+    cout << "  -s tolerance  Simplify the mesh before tracing, keeping the"
+        << " vertical" << endl;
+    cout << "                error of removed vertices within tolerance." << endl;
+    cout << "  -t seconds    Stop tracing after this much wall-clock time."
+        << endl;
+    cout << "  -n steps      Stop tracing after this many trace steps." << endl;
+    cout << "Saddles are traced most significant first. Interrupting the"
+        << " trace keeps" << endl;
+    cout << "the saddles completed so far." << endl;
+    std::abort();
+}
+
+/**
+ * Reserves room in the mesh arena for the polyhedron described by an OFF file.
+ *
+ * Reads the vertex and facet counts from the header and rewinds the stream. A
+ * triangulated surface with V vertices and F facets has about V + F edges. The
+ * node sizes already include the list pointers of their In_place_list.
+ */
+static void reserve_for_off(std::istream& input)
+{
+    std::streampos start = input.tellg();
+    std::string magic;
+    std::size_t nv = 0;
+    std::size_t nf = 0;
+    input >> magic;
+    while ((input >> std::ws).peek() == '#')
+        input.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    input >> nv >> nf;
+    input.clear();
+    input.seekg(start);
+    if (magic.find("OFF") == std::string::npos)
+        return;
+    mesh_arena().reserve(nv * sizeof(Vertex) + 2 * (nv + nf) * sizeof(Halfedge) +
+            nf * sizeof(Facet));
+}
+
+/**
+ * Determines whether v is a saddle, for use with standard algorithms.
+ */
+static bool is_saddle_vertex(const Vertex& v)
+{
+    return is_saddle(Vertex_const_handle(&v));
+}
+
+/**
+ * Stops tracing on an interrupt, keeping the paths traced so far.
+ */
+static void handle_interrupt(int)
+{
+    cancel_tracing();
+}
+
+/**
+ * Prints the heap allocations made since last and updates last.
+ */
+static void report_allocations(const char* phase, Alloc_counts& last)
+{
+    Alloc_counts now = heap_counts();
+    cout << phase << " allocations: " << now.allocations - last.allocations
+        << " (" << now.bytes - last.bytes << " bytes)" << endl;
+    last = now;
+}
+
+/**
+ * Traces saddles within budget into the .paths file for ifname.
+ *
+ * An interrupt stops the trace, keeping the saddles completed so far.
+ */
+template <class V>
+static Trace_report trace_to_file(const std::vector<V>& saddles,
+        const Trace_budget& budget, const char* ifname)
 {
-    if (argc != 2) {
-        cout << "Usage: " << argv[0] << " [input file]" << endl;
+    char pfname[100] = "";
+    snprintf(pfname, 100, "%s.paths", ifname);
+    std::ofstream pfile(pfname);
+    assert(pfile);
+    std::signal(SIGINT, handle_interrupt);
+    Trace_report traced = trace_saddles(saddles, budget, pfile);
+    std::signal(SIGINT, SIG_DFL);
+    return traced;
+}
+
+/**
+ * Prints the summary of a trace of nsaddles saddles.
+ */
+static void report_trace(const Trace_report& traced, std::size_t nsaddles)
+{
+    cout << "Traced " << traced.paths << " paths from " << traced.saddles
+        << " of " << nsaddles << " saddles in " << traced.steps
+        << " steps" << (traced.stopped ? " before stopping." : ".") << endl;
+}
+
+/**
+ * Runs the pipeline on the raster DEM described by the header ifname.
+ *
+ * The raster's triangulation is implicit, so no Polyhedron is built and there
+ * are no edge labels to compute. Tracing is scheduled as it is for meshes.
+ */
+static int run_raster(const char* ifname, const Trace_budget& budget)
+{
+    Raster R;
+    CGAL::Timer t;
+    t.start();
+    if (!R.read(ifname)) {
+        cout << "Failed to read raster " << ifname << endl;
         std::abort();
     }
+    t.stop();
+    cout << "Input time: " << t.time() << endl;
+    t.reset();
+
+    t.start();
+    std::vector<Raster_vertex> saddles;
+    for (std::size_t v = 0; v < R.size_of_vertices(); ++v) {
+        if (R.is_vertex(v) && is_saddle(Raster_vertex(&R, v)))
+            saddles.push_back(Raster_vertex(&R, v));
+    }
+    t.stop();
+    cout << "Saddle finding time: " << t.time() << endl;
+    t.reset();
+    cout << "There are " << saddles.size() << " saddles." << endl;
+
+    char ofname[100] = "";
+    snprintf(ofname, 100, "%s.out", ifname);
+    std::ofstream ofile(ofname);
+    assert(ofile);
+    for (std::vector<Raster_vertex>::iterator it = saddles.begin(); it !=
+            saddles.end(); ++it) {
+        ofile << (*it)->point() << endl;
+    }
+    ofile.close();
+
+    t.start();
+    Trace_report traced = trace_to_file(saddles, budget, ifname);
+    t.stop();
+    cout << "Tracing time: " << t.time() << endl;
+    t.reset();
+    report_trace(traced, saddles.size());
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    bool raster = false;
+    bool reordering = false;
+    bool filling = false;
+    double epsilon = 0.0;
+    bool simplifying = false;
+    double tolerance = 0.0;
+    Trace_budget budget = {0.0, 0};
+    int opt;
+    while ((opt = getopt(argc, argv, "rzf:s:t:n:")) != -1) {
+        switch (opt) {
+            case 'r':
+                raster = true;
+                break;
+            case 'z':
+                reordering = true;
+                break;
+            case 'f':
+                filling = true;
+                epsilon = std::atof(optarg);
+                break;
+            case 's':
+                simplifying = true;
+                tolerance = std::atof(optarg);
+                break;
+            case 't':
+                budget.seconds = std::atof(optarg);
+                break;
+            case 'n':
+                budget.steps = std::strtoul(optarg, 0, 10);
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+    if (argc - optind != 1)
+        usage(argv[0]);
+    const char* ifname = argv[optind];
+    if (raster) {
+        if (reordering)
+            cout << "Rasters are already stored in grid order." << endl;
+        if (filling)
+            cout << "Depression filling is not supported on rasters." << endl;
+        if (simplifying)
+            cout << "Simplification is not supported on rasters." << endl;
+        return run_raster(ifname, budget);
+    }
 
     Polyhedron P;
-    std::ifstream input(argv[1]);
+    std::ifstream input(ifname);
     assert(input);
+    Alloc_counts counts = heap_counts();
     CGAL::Timer t;
     t.start();
+    reserve_for_off(input);
     input >> P;
     // Adds plane equations to all the facets.
     std::transform(P.facets_begin(), P.facets_end(), P.planes_begin(),
@@ -48,33 +257,101 @@ int main(int argc, char** argv)
     t.stop();
     cout << "Input time: " << t.time() << endl;
     t.reset();
+    report_allocations("Input", counts);
+
+    if (filling) {
+        t.start();
+        Fill_report filled = fill_depressions(P, epsilon);
+        t.stop();
+        cout << "Filling time: " << t.time() << endl;
+        t.reset();
+        report_allocations("Filling", counts);
+        cout << "Raised " << filled.raised << " vertices, by at most "
+            << filled.max_raise << " and " << (filled.raised ?
+                    filled.total_raise / filled.raised : 0.0)
+            << " on average." << endl;
+        if (filled.closed_components > 0)
+            cout << filled.closed_components << " components had no border"
+                << " and were flooded from their lowest vertex." << endl;
+    }
+
+    if (simplifying) {
+        t.start();
+        std::size_t removed = simplify(P, tolerance);
+        t.stop();
+        cout << "Simplification time: " << t.time() << endl;
+        t.reset();
+        report_allocations("Simplification", counts);
+        cout << "Removed " << removed << " of " << P.size_of_vertices() +
+            removed << " vertices." << endl;
+    }
+
+    if (reordering) {
+        // Time the phases that walk the whole mesh in input order, on the mesh
+        // that is traced, so they can be compared with the times below.
+        t.start();
+        label_all_edges(P);
+        t.stop();
+        cout << "Labelling time (input order): " << t.time() << endl;
+        t.reset();
+        t.start();
+        std::size_t nsaddles = std::count_if(P.vertices_begin(),
+                P.vertices_end(), is_saddle_vertex);
+        t.stop();
+        cout << "Saddle finding time (input order): " << t.time() << endl;
+        t.reset();
+        cout << "There are " << nsaddles << " saddles." << endl;
+
+        t.start();
+        reorder_morton(P);
+        std::transform(P.facets_begin(), P.facets_end(), P.planes_begin(),
+                Plane_equation());
+        t.stop();
+        cout << "Reordering time: " << t.time() << endl;
+        t.reset();
+        report_allocations("Reordering", counts);
+    }
 
     t.start();
     label_all_edges(P);
     t.stop();
     cout << "Labelling time: " << t.time() << endl;
     t.reset();
+    report_allocations("Labelling", counts);
 
     t.start();
-    std::vector<Vertex> saddles;
-    std::remove_copy_if(P.vertices_begin(), P.vertices_end(),
-            std::back_inserter(saddles), is_not_saddle);
+    std::vector<Vertex_handle> saddles;
+    for (Vertex_iterator i = P.vertices_begin(); i != P.vertices_end(); ++i) {
+        if (is_saddle(i))
+            saddles.push_back(i);
+    }
     t.stop();
     cout << "Saddle finding time: " << t.time() << endl;
     t.reset();
+    report_allocations("Saddle finding", counts);
     cout << "There are " << saddles.size() << " saddles." << endl;
 
     char ofname[100] = "";
-    snprintf(ofname, 100, "%s.out", argv[1]);
+    snprintf(ofname, 100, "%s.out", ifname);
     std::ofstream ofile(ofname);
     assert(ofile);
-    for (std::vector<Vertex>::iterator it = saddles.begin(); it !=
+    for (std::vector<Vertex_handle>::iterator it = saddles.begin(); it !=
             saddles.end(); ++it) {
-        ofile << it->point() << endl;
+        ofile << (*it)->point() << endl;
     }
     ofile.close();
 
-    std::for_each(saddles.begin(), saddles.end(), trace_from_saddle);
+    counts = heap_counts();
+    t.start();
+    Trace_report traced = trace_to_file(saddles, budget, ifname);
+    t.stop();
+    cout << "Tracing time: " << t.time() << endl;
+    t.reset();
+    report_allocations("Tracing", counts);
+    report_trace(traced, saddles.size());
+    cout << "Mesh arena: " << mesh_arena().bytes_allocated() << " of "
+        << mesh_arena().bytes_reserved() << " bytes used in "
+        << mesh_arena().blocks() << " blocks" << endl;
 
     if (DRAWING) {
         Kernel::Iso_cuboid_3 c =
@@ -0,0 +1,178 @@
+#include <cassert>
+#include <algorithm>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <CGAL/Polyhedron_incremental_builder_3.h>
+
+#include "definitions.h"
+#include "reorder.h"
+
+using std::cout;
+using std::endl;
+
+typedef Polyhedron::HalfedgeDS HalfedgeDS;
+
+/**
+ * A facet to be rebuilt, as a run of vertex indices in a shared array.
+ */
+struct Facet_record {
+    unsigned int code;
+    std::size_t start;
+    std::size_t degree;
+
+    bool operator<(const Facet_record& f) const { return code < f.code; }
+};
+
+typedef std::pair<unsigned int, Vertex_handle> Vertex_record;
+
+static bool code_less(const Vertex_record& a, const Vertex_record& b)
+{
+    return a.first < b.first;
+}
+
+/**
+ * Spreads the low 16 bits of x so that they occupy the even bits.
+ */
+static unsigned int spread_bits(unsigned int x)
+{
+    x &= 0x0000ffff;
+    x = (x | (x << 8)) & 0x00ff00ff;
+    x = (x | (x << 4)) & 0x0f0f0f0f;
+    x = (x | (x << 2)) & 0x33333333;
+    x = (x | (x << 1)) & 0x55555555;
+    return x;
+}
+
+/**
+ * Maps xy positions inside a bounding box to 32 bit Morton codes.
+ */
+class Morton_code {
+    public:
+        Morton_code(const CGAL::Bbox_3& box)
+            : xmin(box.xmin()), ymin(box.ymin()),
+              xscale(box.xmax() > xmin ? 65535.0 / (box.xmax() - xmin) : 0.0),
+              yscale(box.ymax() > ymin ? 65535.0 / (box.ymax() - ymin) : 0.0)
+        {
+        }
+
+        unsigned int operator()(double x, double y) const
+        {
+            return spread_bits(quantize(x, xmin, xscale)) |
+                (spread_bits(quantize(y, ymin, yscale)) << 1);
+        }
+
+    private:
+        static unsigned int quantize(double v, double min, double scale)
+        {
+            double q = (v - min) * scale;
+            return q <= 0.0 ? 0 : (q >= 65535.0 ? 65535 : (unsigned int) q);
+        }
+
+        double xmin;
+        double ymin;
+        double xscale;
+        double yscale;
+};
+
+/**
+ * Builds a polyhedron from points and facets in the order given.
+ */
+class Build_reordered : public CGAL::Modifier_base<HalfedgeDS> {
+    public:
+        Build_reordered(const std::vector<Point_3>& points,
+                const std::vector<Facet_record>& facets,
+                const std::vector<std::size_t>& indices)
+            : points(points), facets(facets), indices(indices) {}
+
+        void operator()(HalfedgeDS& hds)
+        {
+            CGAL::Polyhedron_incremental_builder_3<HalfedgeDS> b(hds, true);
+            b.begin_surface(points.size(), facets.size());
+            for (std::size_t i = 0; i < points.size(); ++i)
+                b.add_vertex(points[i]);
+            for (std::size_t i = 0; i < facets.size(); ++i) {
+                b.begin_facet();
+                for (std::size_t j = 0; j < facets[i].degree; ++j)
+                    b.add_vertex_to_facet(indices[facets[i].start + j]);
+                b.end_facet();
+            }
+            b.end_surface();
+        }
+
+    private:
+        const std::vector<Point_3>& points;
+        const std::vector<Facet_record>& facets;
+        const std::vector<std::size_t>& indices;
+};
+
+/**
+ * Rebuilds p with its vertices and facets sorted along a Morton curve.
+ *
+ * Vertices are ordered by the Morton code of their xy position and facets by
+ * the code of their centroid. Each pair of halfedges is created with the first
+ * facet, in that order, that uses its edge, so halfedges follow the curve too.
+ * The old nodes go back to the mesh arena and are reused by the rebuilt mesh.
+ * Facet planes and halfedge types are not carried over and must be
+ * recalculated.
+ */
+void reorder_morton(Polyhedron& p)
+{
+    if (p.empty())
+        return;
+    CGAL::Bbox_3 box = p.vertices_begin()->point().bbox();
+    for (Vertex_iterator i = p.vertices_begin(); i != p.vertices_end(); ++i)
+        box = box + i->point().bbox();
+    Morton_code morton(box);
+
+    std::vector<Vertex_record> vertices;
+    vertices.reserve(p.size_of_vertices());
+    for (Vertex_iterator i = p.vertices_begin(); i != p.vertices_end(); ++i) {
+        vertices.push_back(Vertex_record(morton(
+                        CGAL::to_double(i->point().x()),
+                        CGAL::to_double(i->point().y())), i));
+    }
+    std::stable_sort(vertices.begin(), vertices.end(), code_less);
+
+    std::vector<Point_3> points;
+    std::map<const Vertex*, std::size_t> index;
+    points.reserve(vertices.size());
+    for (std::size_t i = 0; i < vertices.size(); ++i) {
+        points.push_back(vertices[i].second->point());
+        index[&*vertices[i].second] = i;
+    }
+
+    std::vector<Facet_record> facets;
+    std::vector<std::size_t> indices;
+    facets.reserve(p.size_of_facets());
+    indices.reserve(p.size_of_halfedges() / 2);
+    for (Facet_iterator f = p.facets_begin(); f != p.facets_end(); ++f) {
+        Facet_record record;
+        record.start = indices.size();
+        record.degree = 0;
+        double x = 0.0;
+        double y = 0.0;
+        typedef Facet::Halfedge_around_facet_circulator Circulator;
+        Circulator current = f->facet_begin();
+        Circulator end = f->facet_begin();
+        do {
+            const Point_3& point = current->vertex()->point();
+            x += CGAL::to_double(point.x());
+            y += CGAL::to_double(point.y());
+            indices.push_back(index[&*current->vertex()]);
+            ++record.degree;
+        } while (++current != end);
+        record.code = morton(x / record.degree, y / record.degree);
+        facets.push_back(record);
+    }
+    std::stable_sort(facets.begin(), facets.end());
+
+    // clear() hands every node back to the mesh arena, and the builder takes
+    // them over again in the order they were freed.
+    p.clear();
+    Build_reordered builder(points, facets, indices);
+    p.delegate(builder);
+    assert(p.size_of_vertices() == points.size());
+    assert(p.size_of_facets() == facets.size());
+}
@@ -0,0 +1,18 @@
+#ifndef __REORDER_H__
+#define __REORDER_H__
+
+#include "definitions.h"
+
+/**
+ * Rebuilds p with its vertices and facets sorted along a Morton curve.
+ *
+ * Vertices are ordered by the Morton code of their xy position and facets by
+ * the code of their centroid. Each pair of halfedges is created with the first
+ * facet, in that order, that uses its edge, so halfedges follow the curve too.
+ * The old nodes go back to the mesh arena and are reused by the rebuilt mesh.
+ * Facet planes and halfedge types are not carried over and must be
+ * recalculated.
+ */
+void reorder_morton(Polyhedron& p);
+
+#endif
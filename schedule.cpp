@@ -0,0 +1,24 @@
+#include <csignal>
+
+#include "definitions.h"
+#include "schedule.h"
+
+static volatile std::sig_atomic_t cancelled = 0;
+
+/**
+ * Makes a running trace_saddles stop before its next step.
+ *
+ * Only sets a flag, so it may be called from a signal handler.
+ */
+void cancel_tracing()
+{
+    cancelled = 1;
+}
+
+/**
+ * Determines whether cancel_tracing has been called.
+ */
+bool tracing_cancelled()
+{
+    return cancelled;
+}
@@ -0,0 +1,202 @@
+#ifndef __SCHEDULE_H__
+#define __SCHEDULE_H__
+
+#include <cassert>
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <ostream>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include <CGAL/Real_timer.h>
+
+#include "definitions.h"
+#include "primitives.h"
+#include "utils.h"
+#include "watershed.h"
+
+const bool DEBUG_SCHEDULE = false;
+
+/**
+ * Limits on the work done by trace_saddles. A zero limit is no limit.
+ */
+struct Trace_budget {
+    double seconds; // Wall-clock time.
+    std::size_t steps; // Calls to trace_up_once.
+};
+
+/**
+ * Summary of a trace_saddles run.
+ */
+struct Trace_report {
+    std::size_t saddles; // Saddles whose paths were all traced.
+    std::size_t paths; // Complete paths written.
+    std::size_t steps; // Calls to trace_up_once.
+    bool stopped; // Whether the budget or a cancellation ended the run.
+};
+
+/**
+ * Makes a running trace_saddles stop before its next step.
+ *
+ * Only sets a flag, so it may be called from a signal handler.
+ */
+void cancel_tracing();
+
+/**
+ * Determines whether cancel_tracing has been called.
+ */
+bool tracing_cancelled();
+
+/**
+ * Tracks the work done against a Trace_budget.
+ */
+class Budget_tracker {
+    public:
+        Budget_tracker(const Trace_budget& budget)
+            : budget(budget), steps(0)
+        {
+            timer.start();
+        }
+
+        /**
+         * Counts one step, returning false if it may not be taken.
+         */
+        bool step()
+        {
+            if (tracing_cancelled() ||
+                    (budget.steps > 0 && steps >= budget.steps) ||
+                    (budget.seconds > 0 && timer.time() >= budget.seconds))
+                return false;
+            ++steps;
+            return true;
+        }
+
+        std::size_t steps_taken() const { return steps; }
+
+    private:
+        const Trace_budget& budget;
+        std::size_t steps;
+        CGAL::Real_timer timer;
+};
+
+/**
+ * Traces one upslope path from h's vertex into path.
+ *
+ * The path starts up h's edge if it is an upslope ridge, and otherwise up the
+ * generalized ridge on h's left facet. Returns false if the budget ran out
+ * before the path was complete.
+ */
+template <class H>
+bool trace_path(const H& h, std::vector<Point_3>& path,
+        Budget_tracker& tracker)
+{
+    path.clear();
+    path.push_back(h->vertex()->point());
+    Basic_trace_point<H> p;
+    p.h = h;
+    p.t = 1.0;
+    enum TraceFlag flag = TRACE_CONTINUE;
+    do {
+        if (!tracker.step())
+            return false;
+        Point_3 q = trace_up_once(p, flag);
+        // A flat facet ends the path where it already is.
+        if (flag == TRACE_FINISH)
+            break;
+        path.push_back(q);
+    } while (!trace_finished(p));
+    return true;
+}
+
+/**
+ * Returns how significant a saddle is, as the height range of its neighbors.
+ */
+template <class V>
+double saddle_significance(const V& v)
+{
+    typedef typename Vertex_traits<V>::Halfedge Halfedge_type;
+    const Halfedge_type end = v->halfedge();
+    Halfedge_type current = end;
+    double low = CGAL::to_double(v->point().z());
+    double high = low;
+    do {
+        double z = CGAL::to_double(current->opposite()->vertex()->point().z());
+        low = std::min(low, z);
+        high = std::max(high, z);
+    } while ((current = next_around_vertex(current)) != end);
+    return high - low;
+}
+
+/**
+ * Orders ranked saddles by decreasing significance.
+ */
+template <class V>
+bool more_significant(const std::pair<double, V>& a,
+        const std::pair<double, V>& b)
+{
+    return a.first > b.first;
+}
+
+/**
+ * Traces saddles in decreasing order of significance within a budget.
+ *
+ * Each upslope path is written to out as a line holding the saddle's rank
+ * followed by the path's points. A saddle's paths are written together once
+ * all of them are complete, and out is flushed so they can be read while the
+ * trace goes on. A saddle cut short by the budget or by cancel_tracing is
+ * dropped entirely, so out only ever holds whole saddles.
+ */
+template <class V>
+Trace_report trace_saddles(const std::vector<V>& saddles,
+        const Trace_budget& budget, std::ostream& out)
+{
+    typedef typename Vertex_traits<V>::Halfedge Halfedge_type;
+    typedef std::pair<double, V> Ranked_saddle;
+    std::vector<Ranked_saddle> ranked;
+    ranked.reserve(saddles.size());
+    for (std::size_t i = 0; i < saddles.size(); ++i)
+        ranked.push_back(Ranked_saddle(saddle_significance(saddles[i]),
+                    saddles[i]));
+    std::stable_sort(ranked.begin(), ranked.end(), more_significant<V>);
+
+    Trace_report report = {0, 0, 0, false};
+    Budget_tracker tracker(budget);
+    std::vector<Point_3> path;
+    for (std::size_t rank = 0; rank < ranked.size() && !report.stopped;
+            ++rank) {
+        const V& v = ranked[rank].second;
+        assert(is_saddle(v));
+        if (DEBUG_SCHEDULE)
+            std::cout << "Tracing saddle " << rank << " at " << v->point()
+                << " with significance " << ranked[rank].first << std::endl;
+        std::ostringstream paths;
+        std::size_t npaths = 0;
+        const Halfedge_type end = v->halfedge();
+        Halfedge_type current = end;
+        do {
+            if (!is_upslope_ridge(current) && !is_generalized_ridge(current))
+                continue;
+            if (!trace_path(current, path, tracker)) {
+                report.stopped = true;
+                break;
+            }
+            paths << rank;
+            for (std::size_t i = 0; i < path.size(); ++i)
+                paths << " " << path[i];
+            paths << std::endl;
+            ++npaths;
+        } while ((current = next_around_vertex(current)) != end);
+        if (!report.stopped) {
+            out << paths.str();
+            out.flush();
+            report.paths += npaths;
+            ++report.saddles;
+        }
+    }
+    report.steps = tracker.steps_taken();
+    return report;
+}
+
+#endif
@@ -0,0 +1,458 @@
+#include <algorithm>
+#include <cassert>
+#include <set>
+#include <vector>
+
+#include "definitions.h"
+#include "primitives.h"
+#include "utils.h"
+#include "simplify.h"
+
+static bool DEBUG_SIMPLIFY = false;
+
+using std::cout;
+using std::endl;
+
+/**
+ * Projects p onto the xy plane.
+ */
+static Point_2 project(const Point_3& p)
+{
+    return Point_2(p.x(), p.y());
+}
+
+/**
+ * Determines whether two vertices share an edge.
+ */
+static bool is_adjacent(const Vertex_const_handle& u,
+        const Vertex_const_handle& v)
+{
+    typedef Vertex::Halfedge_around_vertex_const_circulator Circulator;
+    Circulator current = u->vertex_begin();
+    Circulator end = u->vertex_begin();
+    do {
+        if (current->opposite()->vertex() == v)
+            return true;
+    } while (++current != end);
+    return false;
+}
+
+/**
+ * The star of a vertex given by its location and the points around it.
+ *
+ * Star_vertex and Star_halfedge act as handles into a star, as Raster_vertex
+ * and Raster_halfedge do for a raster, so the templated saddle and extremum
+ * tests can judge a star that a collapse would make before it is made. Only
+ * the halfedges into and out of the center are represented.
+ */
+struct Star {
+    Point_3 center;
+    std::vector<Point_3> ring; // Neighbors in circulator order.
+    std::vector<bool> border; // Whether no facet follows each neighbor.
+};
+
+class Star_halfedge;
+
+class Star_vertex {
+    public:
+        Star_vertex() : star(0), k(0) {}
+        // k is an index into the ring, or -1 for the center.
+        Star_vertex(const Star* s, int k) : star(s), k(k) {}
+
+        const Star_vertex* operator->() const { return this; }
+
+        Point_3 point() const { return k < 0 ? star->center : star->ring[k]; }
+        Star_halfedge halfedge() const;
+
+    private:
+        const Star* star;
+        int k;
+};
+
+/**
+ * A halfedge into the center of a Star from ring[i], or out of it to ring[i].
+ *
+ * The facet left of the halfedge into the center from ring[i] is the one
+ * between ring[i] and ring[i + 1].
+ */
+class Star_halfedge {
+    public:
+        Star_halfedge() : star(0), i(0), in(true) {}
+        Star_halfedge(const Star* s, int i, bool in) : star(s), i(i), in(in) {}
+
+        const Star_halfedge* operator->() const { return this; }
+
+        // Slopes are always computed, as they are during simplification.
+        static const EdgeType type = NO_TYPE;
+
+        Star_halfedge opposite() const { return Star_halfedge(star, i, !in); }
+
+        Star_halfedge next() const
+        {
+            assert(in);
+            return Star_halfedge(star, (i + 1) % size(), false);
+        }
+
+        Star_vertex vertex() const { return Star_vertex(star, in ? -1 : i); }
+
+        bool is_border() const { return star->border[left()]; }
+
+        const Star_halfedge& facet() const { return *this; }
+
+        /**
+         * Returns the plane of the facet to the left of this halfedge.
+         *
+         * The points are taken in the order of the facet, as Plane_equation
+         * takes them.
+         */
+        Plane_3 plane() const
+        {
+            int f = left();
+            return Plane_3(star->center, star->ring[(f + 1) % size()],
+                    star->ring[f]);
+        }
+
+        bool operator==(const Star_halfedge& h) const
+        {
+            return i == h.i && in == h.in;
+        }
+        bool operator!=(const Star_halfedge& h) const { return !(*this == h); }
+
+    private:
+        int size() const { return star->ring.size(); }
+        // Index of the ring point the left facet starts from.
+        int left() const { return in ? i : (i + size() - 1) % size(); }
+
+        const Star* star;
+        int i;
+        bool in;
+};
+
+Star_halfedge Star_vertex::halfedge() const
+{
+    assert(k < 0);
+    return Star_halfedge(star, 0, true);
+}
+
+template <>
+struct Vertex_traits<Star_vertex> {
+    typedef Star_halfedge Halfedge;
+};
+
+/**
+ * Returns the star of c, with the neighbors' handles in ids.
+ */
+static Star star_of(const Vertex_const_handle& c,
+        std::vector<Vertex_const_handle>& ids)
+{
+    Star star;
+    star.center = c->point();
+    ids.clear();
+    typedef Vertex::Halfedge_around_vertex_const_circulator Circulator;
+    Circulator current = c->vertex_begin();
+    Circulator end = c->vertex_begin();
+    do {
+        ids.push_back(current->opposite()->vertex());
+        star.ring.push_back(current->opposite()->vertex()->point());
+        star.border.push_back(current->is_border());
+    } while (++current != end);
+    return star;
+}
+
+/**
+ * Determines whether c would be a saddle or an extremum exactly when it is now,
+ * were its star replaced by after.
+ */
+static bool keeps_kind(const Vertex_const_handle& c, const Star& after)
+{
+    Star_vertex s(&after, -1);
+    return is_saddle(c) == is_saddle(s) && is_extremum(c) == is_extremum(s);
+}
+
+/**
+ * Determines whether collapsing the edge of h into h's vertex leaves the
+ * vertices that remain around it as saddles and extrema as they are.
+ *
+ * h's vertex v takes over the neighbors of the removed vertex u, and the two
+ * other vertices w and x of h's facets lose u. Other vertices keep their stars.
+ */
+static bool keeps_critical_points(const Halfedge_const_handle& h)
+{
+    Vertex_const_handle u = h->opposite()->vertex();
+    Vertex_const_handle v = h->vertex();
+    Vertex_const_handle ends[2] = {h->next()->vertex(),
+        h->opposite()->next()->vertex()};
+    std::vector<Vertex_const_handle> ids;
+    for (int i = 0; i < 2; ++i) {
+        Star after = star_of(ends[i], ids);
+        std::size_t j = std::find(ids.begin(), ids.end(), u) - ids.begin();
+        assert(j < ids.size());
+        // The facets either side of u merge into one, which is interior.
+        after.ring.erase(after.ring.begin() + j);
+        after.border.erase(after.border.begin() + j);
+        if (!keeps_kind(ends[i], after))
+            return false;
+    }
+
+    std::vector<Vertex_const_handle> around_u;
+    Star star_u = star_of(u, around_u);
+    Star after = star_of(v, ids);
+    std::size_t j = std::find(ids.begin(), ids.end(), u) - ids.begin();
+    std::size_t m = std::find(around_u.begin(), around_u.end(), v) -
+        around_u.begin();
+    assert(j < ids.size() && m < around_u.size());
+    // Going on around u from v meets the neighbor before u around v first and
+    // the one after it last. v already has those two, and gains the rest.
+    std::vector<Point_3> fan;
+    const std::size_t n = around_u.size();
+    for (std::size_t k = 2; k + 1 < n; ++k)
+        fan.push_back(star_u.ring[(m + k) % n]);
+    after.ring.erase(after.ring.begin() + j);
+    after.ring.insert(after.ring.begin() + j, fan.begin(), fan.end());
+    after.border.erase(after.border.begin() + j);
+    after.border.insert(after.border.begin() + j, fan.size(), false);
+    return keeps_kind(v, after);
+}
+
+/**
+ * Measures the vertical distance from q to the triangle abc.
+ *
+ * Returns false if q does not lie over or under the triangle.
+ */
+static bool vertical_error(const Point_3& q, const Point_3& a,
+        const Point_3& b, const Point_3& c, double& error)
+{
+    typedef Kernel::Triangle_2 Triangle_2;
+    if (Triangle_2(project(a), project(b), project(c)).bounded_side(project(q))
+            == CGAL::ON_UNBOUNDED_SIDE)
+        return false;
+    Plane_3 plane = Plane_3(a, b, c);
+    Kernel::FT z = -(plane.a() * q.x() + plane.b() * q.y() + plane.d()) /
+        plane.c();
+    error = CGAL::to_double(CGAL::abs(z - q.z()));
+    return true;
+}
+
+/**
+ * Appends u and every removed vertex under the facets around u to points.
+ */
+static void gather_removed(const Vertex_const_handle& u,
+        const Removed_points& removed, std::vector<Point_3>& points)
+{
+    points.push_back(u->point());
+    typedef Vertex::Halfedge_around_vertex_const_circulator Circulator;
+    Circulator current = u->vertex_begin();
+    Circulator end = u->vertex_begin();
+    do {
+        if (current->is_border())
+            continue;
+        Removed_points::const_iterator i = removed.find(&*current->facet());
+        if (i != removed.end())
+            points.insert(points.end(), i->second.begin(), i->second.end());
+    } while (++current != end);
+}
+
+/**
+ * Decimates p by collapsing edges in monotone and flat regions.
+ *
+ * Vertices that are saddles or extrema, either before simplification or at the
+ * time they would be collapsed, are never removed, and no collapse makes or
+ * unmakes a saddle or extremum among the vertices left. Each removed vertex is
+ * remembered with the facet lying over it, and a collapse is only made if every
+ * vertex under the facets it replaces stays within tolerance, vertically, of the
+ * new facets. Facet planes must be set before calling and are kept up to date.
+ * Returns the number of vertices removed.
+ */
+std::size_t simplify(Polyhedron& p, double tolerance)
+{
+    // type is not initialized by the constructor, and slopes_into relies on it.
+    for (Halfedge_iterator i = p.halfedges_begin(); i != p.halfedges_end(); ++i)
+        i->type = NO_TYPE;
+
+    std::set<const Vertex*> critical;
+    for (Vertex_iterator i = p.vertices_begin(); i != p.vertices_end(); ++i) {
+        if (is_saddle(i) || is_extremum(i))
+            critical.insert(&*i);
+    }
+
+    Removed_points points;
+    std::size_t removed = 0;
+    bool changed;
+    do {
+        changed = false;
+        Vertex_iterator i = p.vertices_begin();
+        while (i != p.vertices_end()) {
+            // Collapsing only removes u, so i stays valid.
+            Vertex_iterator u = i++;
+            if (critical.count(&*u) || is_saddle(u) || is_extremum(u))
+                continue;
+            typedef Vertex::Halfedge_around_vertex_circulator Circulator;
+            Circulator current = u->vertex_begin();
+            Circulator end = u->vertex_begin();
+            Halfedge_handle best;
+            double best_error = tolerance;
+            bool found = false;
+            do {
+                double error;
+                Halfedge_handle h = current->opposite();
+                if (collapse_error(h, points, error) && error <= best_error) {
+                    best = h;
+                    best_error = error;
+                    found = true;
+                }
+            } while (++current != end);
+            if (found) {
+                if (DEBUG_SIMPLIFY) {
+                    cout << "Collapsing with error " << best_error << ":" << endl;
+                    print_halfedge(best);
+                }
+                collapse_edge(p, best, points);
+                ++removed;
+                changed = true;
+            }
+        }
+    } while (changed);
+    return removed;
+}
+
+/**
+ * Determines whether the edge of h can be collapsed into h's vertex.
+ *
+ * The collapse must keep the mesh a manifold TIN: both facets of h must be
+ * interior, the link condition must hold, and no facet around the removed
+ * vertex may flip or degenerate in the xy plane. Nor may the collapse change
+ * whether any vertex left around it is a saddle or an extremum. h's opposite
+ * vertex is the one to be removed. On success, error is set to the largest
+ * vertical distance between the simplified surface and that vertex or any
+ * vertex in removed that lies under its facets.
+ */
+bool collapse_error(const Halfedge_const_handle& h,
+        const Removed_points& removed, double& error)
+{
+    if (h->is_border() || h->opposite()->is_border())
+        return false;
+    // These edges are removed by join_facet, so their other sides must exist.
+    if (h->next()->opposite()->is_border() ||
+            h->opposite()->prev()->opposite()->is_border())
+        return false;
+
+    Vertex_const_handle u = h->opposite()->vertex();
+    Vertex_const_handle v = h->vertex();
+    Vertex_const_handle w = h->next()->vertex();
+    Vertex_const_handle x = h->opposite()->next()->vertex();
+    if (w == x || w->vertex_degree() < 4 || x->vertex_degree() < 4)
+        return false;
+
+    // Link condition: u and v may only share the neighbors w and x.
+    typedef Vertex::Halfedge_around_vertex_const_circulator Circulator;
+    Circulator current = u->vertex_begin();
+    Circulator end = u->vertex_begin();
+    do {
+        Vertex_const_handle n = current->opposite()->vertex();
+        if (n != v && n != w && n != x && is_adjacent(n, v))
+            return false;
+    } while (++current != end);
+
+    // Every remaining facet around u is moved onto v, and none of them may
+    // flip. The new facets then cover the same area as the old ones.
+    const Point_2 u_2 = project(u->point());
+    const Point_2 v_2 = project(v->point());
+    std::vector<Point_3> corners;
+    current = u->vertex_begin();
+    do {
+        Halfedge_const_handle g = current;
+        if (g == h->opposite() || g == h->prev())
+            continue;
+        const Point_3& a = current->opposite()->vertex()->point();
+        const Point_3& b = current->next()->vertex()->point();
+        CGAL::Orientation before =
+            CGAL::orientation(project(a), u_2, project(b));
+        CGAL::Orientation after = CGAL::orientation(project(a), v_2, project(b));
+        if (after == CGAL::COLLINEAR || after != before)
+            return false;
+        corners.push_back(a);
+        corners.push_back(b);
+    } while (++current != end);
+
+    // Saddles and extrema must survive, and none may appear.
+    if (!keeps_critical_points(h))
+        return false;
+
+    // Every vertex under the old facets must lie under one of the new ones.
+    std::vector<Point_3> points;
+    gather_removed(u, removed, points);
+    error = 0;
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        double e;
+        bool measured = false;
+        for (std::size_t j = 0; j < corners.size() && !measured; j += 2) {
+            measured = vertical_error(points[i], corners[j], v->point(),
+                    corners[j + 1], e);
+        }
+        if (!measured)
+            return false;
+        if (e > error)
+            error = e;
+    }
+    return true;
+}
+
+/**
+ * Collapses the edge of h, removing h's opposite vertex.
+ *
+ * The two facets incident to h are removed and the planes of the facets around
+ * h's vertex are recalculated. The removed vertex, and those in removed that
+ * lay under the old facets, are moved to the new facets lying over them.
+ */
+void collapse_edge(Polyhedron& p, Halfedge_handle h, Removed_points& removed)
+{
+    Vertex_handle u = h->opposite()->vertex();
+    Vertex_handle v = h->vertex();
+
+    // The facets around u are about to be destroyed, so take their vertices.
+    std::vector<Point_3> points;
+    gather_removed(u, removed, points);
+    typedef Vertex::Halfedge_around_vertex_circulator Circulator;
+    Circulator current = u->vertex_begin();
+    Circulator end = u->vertex_begin();
+    do {
+        if (!current->is_border())
+            removed.erase(&*current->facet());
+    } while (++current != end);
+    // join_facet also deletes the facets across v-w and x-v. Their shapes
+    // survive in other facets, so their vertices are placed again below.
+    const Facet* joined[2] = {&*h->next()->opposite()->facet(),
+        &*h->opposite()->prev()->opposite()->facet()};
+    for (int i = 0; i < 2; ++i) {
+        Removed_points::iterator j = removed.find(joined[i]);
+        if (j != removed.end()) {
+            points.insert(points.end(), j->second.begin(), j->second.end());
+            removed.erase(j);
+        }
+    }
+
+    // Merge each facet of h with its neighbor so that joining the vertices
+    // leaves triangles rather than digons.
+    p.join_facet(h->next());
+    p.join_facet(h->opposite()->prev());
+    p.join_vertex(h);
+
+    std::vector<bool> placed(points.size(), false);
+    current = v->vertex_begin();
+    end = v->vertex_begin();
+    do {
+        if (current->is_border())
+            continue;
+        current->facet()->plane() = Plane_equation()(*current->facet());
+        const Point_3& a = current->opposite()->vertex()->point();
+        const Point_3& b = current->next()->vertex()->point();
+        for (std::size_t i = 0; i < points.size(); ++i) {
+            double e;
+            if (!placed[i] && vertical_error(points[i], a, v->point(), b, e)) {
+                removed[&*current->facet()].push_back(points[i]);
+                placed[i] = true;
+            }
+        }
+    } while (++current != end);
+    assert(std::find(placed.begin(), placed.end(), false) == placed.end());
+}
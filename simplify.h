@@ -0,0 +1,47 @@
+#ifndef __SIMPLIFY_H__
+#define __SIMPLIFY_H__
+
+#include <cstddef>
+#include <map>
+#include <vector>
+
+#include "definitions.h"
+
+/**
+ * Original vertices removed by simplify, keyed by the facet lying over them.
+ */
+typedef std::map<const Facet*, std::vector<Point_3> > Removed_points;
+
+/**
+ * Decimates p by collapsing edges in monotone and flat regions.
+ *
+ * Vertices that are saddles or extrema, either before simplification or at the
+ * time they would be collapsed, are never removed, and no collapse makes or
+ * unmakes a saddle or extremum among the vertices left. Every removed vertex
+ * stays within tolerance, vertically, of the simplified surface above or below
+ * it. Facet planes must be set before calling and are kept up to date. Returns
+ * the number of vertices removed.
+ */
+std::size_t simplify(Polyhedron& p, double tolerance);
+
+/**
+ * Determines whether the edge of h can be collapsed into h's vertex.
+ *
+ * The collapse may not change whether any vertex left around it is a saddle or
+ * an extremum. h's opposite vertex is the one to be removed. On success, error
+ * is set to the largest vertical distance between the simplified surface and
+ * that vertex or any vertex in removed that lies under its facets.
+ */
+bool collapse_error(const Halfedge_const_handle& h,
+        const Removed_points& removed, double& error);
+
+/**
+ * Collapses the edge of h, removing h's opposite vertex.
+ *
+ * The two facets incident to h are removed and the planes of the facets around
+ * h's vertex are recalculated. The removed vertex, and those in removed that
+ * lay under the old facets, are moved to the new facets lying over them.
+ */
+void collapse_edge(Polyhedron& p, Halfedge_handle h, Removed_points& removed);
+
+#endif
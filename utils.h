@@ -1,7 +1,13 @@
 #ifndef __UTILS_H__
 #define __UTILS_H__
 
+#include <cassert>
+#include <iostream>
+
 #include "definitions.h"
+#include "primitives.h"
+
+const bool DEBUG_UTIL = false;
 
 enum TraceFlag {
     TRACE_CONTINUE,
@@ -9,15 +15,45 @@ enum TraceFlag {
     TRACE_FINISH
 };
 
+/**
+ * Exit points closer than this fraction of an edge to a vertex snap to it.
+ */
+const double TRACE_SNAP = 1e-9;
+
+/**
+ * A point on an upslope trace, kept as a position on the mesh.
+ *
+ * The point lies on the edge of h at fraction t of the way from h's source to
+ * h's vertex, so t == 1 is h's vertex itself. The trace continues across the
+ * facet left of h. Because the point is rebuilt from the edge's vertices at each
+ * step, exact constructions never depend on earlier steps of the trace.
+ */
+template <class H>
+struct Basic_trace_point {
+    H h;
+    double t;
+};
+
+typedef Basic_trace_point<Halfedge_handle> Trace_point;
+
 /**
  * Calculates the edge type of a halfedge that has not already been typed.
  */
 enum EdgeType edge_type(const Halfedge_const_handle& h);
 
 /**
- * Determines whether v is not a saddle.
+ * Returns the xy location of a trace point.
  */
-bool is_not_saddle(const Vertex& v);
+template <class H>
+Point_2 trace_point_2(const Basic_trace_point<H>& p)
+{
+    const Point_3 target = p.h->vertex()->point();
+    if (p.t >= 1.0)
+        return Point_2(target.x(), target.y());
+    const Point_3 source = p.h->opposite()->vertex()->point();
+    return edge_point(Point_2(source.x(), source.y()),
+            Point_2(target.x(), target.y()), p.t);
+}
 
 /**
  * Determines whether v is a saddle.
@@ -25,7 +61,64 @@ bool is_not_saddle(const Vertex& v);
  * A point is a saddle if it has a border halfedge coming from it or more than
  * one channel or ridge.
  */
-bool is_saddle(const Vertex_const_handle& v);
+template <class V>
+bool is_saddle(const V& v)
+{
+    typedef typename Vertex_traits<V>::Halfedge Halfedge_type;
+    if (DEBUG_UTIL)
+        print_neighborhood(v);
+    const Halfedge_type end = v->halfedge();
+    Halfedge_type current = end;
+    int count[2] = {0, 0}; // Tracks the number of ridges and channels
+    do {
+        if (current->is_border()) {
+            if (DEBUG_UTIL) {
+                std::cout << "Border edge:" << std::endl;
+                print_halfedge(current);
+            }
+            return true;
+        }
+        if (DEBUG_UTIL)
+            std::cout << "Normal: "
+                << current->facet()->plane().orthogonal_vector() << std::endl;
+        if (is_ridge(current))
+            ++count[0];
+        else if (is_channel(current))
+            ++count[1];
+        if (is_generalized_ridge(current))
+            ++count[0];
+        else if (is_generalized_channel(current))
+            ++count[1];
+    } while ((current = next_around_vertex(current)) != end);
+    assert(count[0] == count[1]);
+    return (count[0] > 1 || count[1] > 1);
+}
+
+/**
+ * Determines whether v is a peak or a pit.
+ *
+ * A point is an extremum if all of its neighbors are strictly lower or all of
+ * them are strictly higher. A neighbor at the same height makes the point part
+ * of a flat rather than an extremum.
+ */
+template <class V>
+bool is_extremum(const V& v)
+{
+    typedef typename Vertex_traits<V>::Halfedge Halfedge_type;
+    const Point_3 here = v->point();
+    const Halfedge_type end = v->halfedge();
+    Halfedge_type current = end;
+    bool all_higher = true;
+    bool all_lower = true;
+    do {
+        const Point_3 p = current->opposite()->vertex()->point();
+        if (p.z() <= here.z())
+            all_higher = false;
+        if (p.z() >= here.z())
+            all_lower = false;
+    } while ((current = next_around_vertex(current)) != end);
+    return all_higher || all_lower;
+}
 
 /**
  * Finds the halfedge whose left face has the steepest slope.
@@ -33,15 +126,91 @@ bool is_saddle(const Vertex_const_handle& v);
  * The returned halfedge or its left face must have the steepest slope around v.
  * This is exclusive of the next halfedge around the vertex.
  */
-Halfedge_handle find_steepest_path(Vertex_handle v);
+template <class V>
+typename Vertex_traits<V>::Halfedge find_steepest_path(const V& v)
+{
+    typedef typename Vertex_traits<V>::Halfedge Halfedge_type;
+    const Point_3 here = v->point();
+    const Halfedge_type end = v->halfedge();
+    Halfedge_type current = end;
+    Vector_3 steepest_vector = Vector_3(1, 0, 0);
+    Halfedge_type steepest_halfedge = current;
+    do {
+        Vector_3 normal;
+        // The steepest path must be an upslope ridge or a generalized ridge.
+        if (is_upslope_ridge(current))
+            normal = Vector_3(here, current->opposite()->vertex()->point());
+        else if (is_generalized_ridge(current)) {
+            Vector_3 perp = current->facet()->plane().orthogonal_vector();
+            normal = Vector_3(perp.x(), perp.y(), 1 / perp.z());
+        }
+        else
+            continue;
+        if (is_steeper(normal, steepest_vector)) {
+            steepest_vector = normal;
+            steepest_halfedge = current;
+        }
+    } while ((current = next_around_vertex(current)) != end);
+    if (DEBUG_UTIL) {
+        print_neighborhood(v);
+        std::cout << "Steepest vector: " << steepest_vector << std::endl;
+        std::cout << "Steepest halfedge: " << std::endl;
+        print_halfedge(steepest_halfedge);
+    }
+    return steepest_halfedge;
+}
 
 /**
- * Returns the exit point of the upslope path beginning at h's vertex.
+ * Moves p to the exit point of the upslope path across the facet left of p.h.
  *
- * Updates flag to reflect whether a new vertex must be added to the graph
- * or if the exit point is at an existent vertex. Updates h so that it is the
- * halfedge on which the exit point is located.
+ * Sets flag to TRACE_POINT if the exit point is at an existent vertex, in which
+ * case p.h points into that vertex and p.t is 1. Otherwise sets flag to
+ * TRACE_CONTINUE and p.h is the halfedge opposite the exit edge, so the next
+ * facet to trace is on its left. Returns the exit point. A flat facet has no
+ * upslope path, so there flag is set to TRACE_FINISH and p is left where it is.
  */
-Point_3 find_upslope_intersection(Halfedge_handle& h, TraceFlag& flag);
+template <class H>
+Point_3 find_upslope_intersection(Basic_trace_point<H>& p, TraceFlag& flag)
+{
+    const Plane_3 plane = p.h->facet()->plane();
+    Vector_3 normal_3 = plane.orthogonal_vector();
+    // We need the upslope, not downslope path, so we negate x and y vals.
+    Vector_2 normal_2 = Vector_2(-normal_3.x(), -normal_3.y());
+    if (normal_2 == CGAL::NULL_VECTOR) {
+        flag = TRACE_FINISH;
+        const Point_3 target = p.h->vertex()->point();
+        if (p.t >= 1.0)
+            return target;
+        const Point_3 source = p.h->opposite()->vertex()->point();
+        return source + (target - source) * Kernel::FT(p.t);
+    }
+    Point_2 start_point = trace_point_2(p);
+    Ray_2 upslope_path = Ray_2(start_point, normal_2);
+
+    H h = p.h;
+    Point_2 exit_2 = find_exit(h, upslope_path, start_point);
+    // Keep only the position of the exit point along h, so the next step
+    // starts from h's vertices rather than from this step's construction.
+    const Point_3 source = h->opposite()->vertex()->point();
+    const Point_3 target = h->vertex()->point();
+    double t = edge_parameter(Point_2(source.x(), source.y()),
+            Point_2(target.x(), target.y()), exit_2);
+    if (t >= 1.0 - TRACE_SNAP) {
+        p.h = h;
+        p.t = 1.0;
+        flag = TRACE_POINT;
+        return target;
+    }
+    if (t <= TRACE_SNAP) {
+        p.h = h->opposite();
+        p.t = 1.0;
+        flag = TRACE_POINT;
+        return source;
+    }
+    p.h = h->opposite();
+    p.t = 1.0 - t;
+    flag = TRACE_CONTINUE;
+    return source + (target - source) * Kernel::FT(t);
+}
 
 #endif
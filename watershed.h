@@ -1,7 +1,11 @@
 #ifndef __WATERSHED_H__
 #define __WATERSHED_H__
 
+#include <cassert>
+
 #include "definitions.h"
+#include "primitives.h"
+#include "utils.h"
 
 /**
  * Set the label on all edges to be CHANNEL, RIDGE, or TRANSVERSE.
@@ -9,31 +13,44 @@
 void label_all_edges(Polyhedron& p);
 
 /**
- * Trace all upslope paths from a saddle vertex.
- *
- * Creates edges in the graph along all steepest paths up from the vertex,
- * tracing them until they reach a saddle or a ridge.
- */
-void trace_from_saddle(Vertex& v);
-
-/**
- * Trace up from this edge's vertex along the face to its left.
- */
-void trace_up(Halfedge_handle& h);
-
-/**
- * Trace up one face and modify h to be ready for the next trace.
+ * Trace up one face or edge and modify p to be ready for the next trace.
  *
- * h must have the next face to be traced on its left, and its point must be the
- * next point to be traced from.
+ * p must be the next point to be traced from. If flag is TRACE_POINT, the way
+ * up from p's vertex is chosen with find_steepest_path. Otherwise p.h gives it:
+ * from a vertex, an upslope ridge p.h is followed to its source, and anything
+ * else has the next face to be traced on its left. Returns the point reached.
  */
-void trace_up_once(Halfedge_handle& h, TraceFlag& flag);
+template <class H>
+Point_3 trace_up_once(Basic_trace_point<H>& p, TraceFlag& flag)
+{
+    if (flag == TRACE_POINT) {
+        assert(!is_saddle(p.h->vertex()));
+        p.h = find_steepest_path(p.h->vertex());
+        p.t = 1.0;
+    }
+    if (p.t >= 1.0 && is_upslope_ridge(p.h)) {
+        // Both facets slope away from a ridge, so the path runs along it.
+        p.h = p.h->opposite();
+        flag = TRACE_POINT;
+        return p.h->vertex()->point();
+    }
+    return find_upslope_intersection(p, flag);
+}
 
 /**
  * Determine whether a traceup has finished.
  *
- * A traceup is finished when it reaches a saddle point, a ridge, or a border.
+ * A traceup is finished when it reaches a saddle point, an extremum, a ridge,
+ * or a border.
  */
-bool trace_finished(const Halfedge_const_handle& h);
+template <class H>
+bool trace_finished(const Basic_trace_point<H>& p)
+{
+    if (p.h->is_border())
+        return true;
+    if (p.t >= 1.0)
+        return is_saddle(p.h->vertex()) || is_extremum(p.h->vertex());
+    return is_ridge(p.h);
+}
 
 #endif